@@ -0,0 +1,223 @@
+#include "batch_metrics.h"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+
+void TaskMetrics::start( size_t nTotalIters_ )
+{
+    nTotalIters.store( nTotalIters_, std::memory_order_relaxed );
+    startTime.store( Clock::now().time_since_epoch().count(),
+                     std::memory_order_relaxed );
+    state.store( Running, std::memory_order_release );
+}
+
+
+void TaskMetrics::update( size_t imfIndex_, size_t nIter_ )
+{
+    imfIndex.store( imfIndex_, std::memory_order_relaxed );
+    nIter.store( nIter_, std::memory_order_relaxed );
+}
+
+
+void TaskMetrics::setBestCost( double cost )
+{
+    bestCost.store( cost, std::memory_order_relaxed );
+    hasBestCost.store( true, std::memory_order_release );
+}
+
+
+void TaskMetrics::finish( State finalState )
+{
+    assert( finalState != Queued && finalState != Running );
+    finishTime.store( Clock::now().time_since_epoch().count(),
+                      std::memory_order_relaxed );
+    state.store( finalState, std::memory_order_release );
+}
+
+
+TaskMetrics::Snapshot TaskMetrics::getSnapshot() const
+{
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+    auto result = Snapshot{};
+    result.state = State( state.load( std::memory_order_acquire ) );
+    result.imfIndex = imfIndex.load( std::memory_order_relaxed );
+    result.nIter = nIter.load( std::memory_order_relaxed );
+    result.nTotalIters = nTotalIters.load( std::memory_order_relaxed );
+    result.bestCost = hasBestCost.load( std::memory_order_acquire )
+            ? bestCost.load( std::memory_order_relaxed )
+            : nan;
+    result.itersPerSecond = nan;
+    result.etaSeconds = nan;
+    if ( result.state == Queued )
+        return result;
+
+    const auto endTime = result.state != Running
+            ? Clock::duration( finishTime.load( std::memory_order_relaxed ) )
+            : Clock::now().time_since_epoch();
+    const auto seconds = std::chrono::duration<double>(
+                endTime -
+                Clock::duration( startTime.load( std::memory_order_relaxed ) )
+                ).count();
+    if ( seconds > 0 )
+        result.itersPerSecond = result.nIter / seconds;
+    if ( result.state == Finished )
+        result.etaSeconds = 0;
+    else if ( result.state == Running &&
+              result.itersPerSecond > 0 &&
+              result.nTotalIters >= result.nIter )
+        result.etaSeconds =
+                (result.nTotalIters - result.nIter) / result.itersPerSecond;
+    return result;
+}
+
+
+BatchMetrics::BatchMetrics(
+        std::vector<std::shared_ptr<const TaskMetrics> > tasks )
+    : tasks(std::move(tasks))
+{
+}
+
+
+size_t BatchMetrics::getNTasks() const
+{
+    return tasks.size();
+}
+
+
+const TaskMetrics & BatchMetrics::getTaskMetrics( size_t taskIndex ) const
+{
+    assert( taskIndex < tasks.size() );
+    return *tasks[taskIndex];
+}
+
+
+static const char * getStateName( TaskMetrics::State state )
+{
+    switch ( state )
+    {
+    case TaskMetrics::Queued   : return "queued";
+    case TaskMetrics::Running  : return "running";
+    case TaskMetrics::Finished : return "finished";
+    case TaskMetrics::Cancelled: return "cancelled";
+    case TaskMetrics::Failed   : return "failed";
+    }
+    assert( !"Invalid state." );
+    return "";
+}
+
+
+std::string BatchMetrics::toPrometheusText() const
+{
+    const auto nTasks = getNTasks();
+    auto snapshots = std::vector<TaskMetrics::Snapshot>{};
+    for ( auto i = size_t{}; i < nTasks; ++i )
+        snapshots.push_back( tasks[i]->getSnapshot() );
+
+    std::ostringstream os;
+    os.precision( std::numeric_limits<double>::digits10 + 1 );
+    os << "# HELP dimf_batch_tasks Number of tasks in the batch.\n"
+          "# TYPE dimf_batch_tasks gauge\n"
+          "dimf_batch_tasks " << nTasks << '\n';
+    const auto printMetric = [&]( const char * name,
+                                  const char * type,
+                                  const char * help,
+                                  double (*get)( const TaskMetrics::Snapshot & ) )
+    {
+        os << "# HELP " << name << ' ' << help << '\n'
+           << "# TYPE " << name << ' ' << type << '\n';
+        for ( auto i = size_t{}; i < nTasks; ++i )
+        {
+            const auto value = get( snapshots[i] );
+            os << name << "{task=\"" << i << "\"} ";
+            if ( std::isnan( value ) )
+                os << "NaN";
+            else
+                os << value;
+            os << '\n';
+        }
+    };
+    printMetric( "dimf_task_running", "gauge",
+                 "1 if the task is running, 0 otherwise.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return double( s.state == TaskMetrics::Running ); } );
+    printMetric( "dimf_task_finished", "gauge",
+                 "1 if the task has finished successfully, 0 otherwise.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return double( s.state == TaskMetrics::Finished ); } );
+    printMetric( "dimf_task_cancelled", "gauge",
+                 "1 if the task has been cancelled or aborted, 0 otherwise.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return double( s.state == TaskMetrics::Cancelled ); } );
+    printMetric( "dimf_task_failed", "gauge",
+                 "1 if the task has terminated with an error, 0 otherwise.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return double( s.state == TaskMetrics::Failed ); } );
+    printMetric( "dimf_task_imf_index", "gauge",
+                 "Index of the IMF currently being optimized.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return double( s.imfIndex ); } );
+    printMetric( "dimf_task_iterations_total", "counter",
+                 "Number of iterations done so far.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return double( s.nIter ); } );
+    printMetric( "dimf_task_iterations_planned", "gauge",
+                 "Total number of iterations of the task.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return double( s.nTotalIters ); } );
+    printMetric( "dimf_task_best_cost", "gauge",
+                 "Best cost found so far.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return s.bestCost; } );
+    printMetric( "dimf_task_iterations_per_second", "gauge",
+                 "Average number of iterations per second.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return s.itersPerSecond; } );
+    printMetric( "dimf_task_eta_seconds", "gauge",
+                 "Estimated number of seconds until the task finishes.",
+                 []( const TaskMetrics::Snapshot & s )
+                 { return s.etaSeconds; } );
+    return os.str();
+}
+
+
+static void printJsonNumber( std::ostream & os, double value )
+{
+    if ( std::isnan( value ) || std::isinf( value ) )
+        os << "null";
+    else
+        os << value;
+}
+
+
+std::string BatchMetrics::toJson() const
+{
+    std::ostringstream os;
+    os.precision( std::numeric_limits<double>::digits10 + 1 );
+    const auto nTasks = getNTasks();
+    os << "{\"tasks\":[";
+    for ( auto i = size_t{}; i < nTasks; ++i )
+    {
+        const auto s = tasks[i]->getSnapshot();
+        if ( i != 0 )
+            os << ',';
+        os << "{\"task\":" << i
+           << ",\"state\":\"" << getStateName( s.state ) << '"'
+           << ",\"imfIndex\":" << s.imfIndex
+           << ",\"nIter\":" << s.nIter
+           << ",\"nPlannedIters\":" << s.nTotalIters
+           << ",\"bestCost\":";
+        printJsonNumber( os, s.bestCost );
+        os << ",\"itersPerSecond\":";
+        printJsonNumber( os, s.itersPerSecond );
+        os << ",\"etaSeconds\":";
+        printJsonNumber( os, s.etaSeconds );
+        os << '}';
+    }
+    os << "]}\n";
+    return os.str();
+}
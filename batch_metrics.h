@@ -0,0 +1,78 @@
+/** @file
+  @author Ralph Tandetzky
+  @date 19 Oct 2026
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Live metrics of a single task of a batch run.
+///
+/// The update functions are called from the optimization callbacks of the
+/// task. They only store into atomics and never lock, so they are cheap
+/// enough for @c howToContinue and @c receiveBestFit. The values may be
+/// read from any other thread at any time.
+class TaskMetrics
+{
+public:
+    enum State { Queued, Running, Finished, Cancelled, Failed };
+
+    void start( size_t nTotalIters );
+    void update( size_t imfIndex, size_t nIter );
+    void setBestCost( double cost );
+    /// Sets the final state, which is one of @c Finished, @c Cancelled
+    /// and @c Failed.
+    void finish( State finalState );
+
+    struct Snapshot
+    {
+        State state;
+        size_t imfIndex;
+        size_t nIter;
+        size_t nTotalIters;
+        double bestCost;
+        double itersPerSecond;
+        double etaSeconds;
+    };
+    Snapshot getSnapshot() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<int> state{Queued};
+    std::atomic<size_t> imfIndex{0};
+    std::atomic<size_t> nIter{0};
+    std::atomic<size_t> nTotalIters{0};
+    std::atomic<double> bestCost{0};
+    std::atomic<bool> hasBestCost{false};
+    std::atomic<Clock::rep> startTime{0};
+    std::atomic<Clock::rep> finishTime{0};
+};
+
+/// The live metrics of all tasks of a batch run.
+///
+/// The task metrics are shared, because a task kept by an incremental
+/// re-run belongs to several batch runs.
+class BatchMetrics
+{
+public:
+    explicit BatchMetrics(
+            std::vector<std::shared_ptr<const TaskMetrics> > tasks );
+
+    size_t getNTasks() const;
+    const TaskMetrics & getTaskMetrics( size_t taskIndex ) const;
+
+    /// Renders the metrics in the Prometheus text exposition format.
+    std::string toPrometheusText() const;
+    /// Renders the metrics as a JSON object.
+    std::string toJson() const;
+
+private:
+    const std::vector<std::shared_ptr<const TaskMetrics> > tasks;
+};
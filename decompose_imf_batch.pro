@@ -1,4 +1,4 @@
-QT += core gui
+QT += core gui network
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 QMAKE_CXXFLAGS += -std=c++11 -pedantic
 
@@ -8,13 +8,19 @@ DEPENDPATH += . ../cpp_utils/ ../qt_utils/ ../decompose_imf_lib/
 INCLUDEPATH += ..
 
 HEADERS  += \
+    batch_metrics.h \
     gui_main_window.h \
-    parse_batch.h
+    metrics_server.h \
+    parse_batch.h \
+    worker_placement.h
 
 SOURCES += \
 	main.cpp \
+    batch_metrics.cpp \
     gui_main_window.cpp \
-    parse_batch.cpp
+    metrics_server.cpp \
+    parse_batch.cpp \
+    worker_placement.cpp
 
 FORMS    += \
     gui_main_window.ui
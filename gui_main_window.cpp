@@ -1,6 +1,9 @@
 #include "gui_main_window.h"
 #include "ui_gui_main_window.h"
+#include "batch_metrics.h"
+#include "metrics_server.h"
 #include "parse_batch.h"
+#include "worker_placement.h"
 
 #include "../decompose_imf_lib/optimization_task.h"
 
@@ -19,9 +22,20 @@
 
 #include <QSettings>
 
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
 #include <iostream>
+#include <set>
+#include <sstream>
+#include <thread>
 
 static const char * tasksTextName = "tasksText";
+static const char * incrementalName = "incremental";
+static const char * metricsPortName = "metricsPort";
+// Port of the metrics endpoint, if none is configured. Zero disables it.
+static const quint16 defaultMetricsPort = 9464;
 
 namespace gui {
 
@@ -54,19 +68,92 @@ static void printImfs( const std::vector<std::vector<double> > & imfs,
 
 struct MainWindow::Impl
 {
-    void runBatchStep(
-            BatchOptimizationParams optParam,
-            cu::ProgressInterface * progress,
-            std::ostream & os );
+    // The progress bar of the tasks queued by one call of runBatch().
+    struct ProgressGroup
+    {
+        decltype(qu::createProgress("")) progress;
+        std::unique_ptr<cu::ParallelProgress> parProgress;
+    };
 
-    Ui::MainWindow ui;
+    // A task of a batch run. An incremental re-run keeps the unchanged
+    // tasks of the previous batch run, so a task may belong to several
+    // batch runs.
+    struct TaskRun
+    {
+        explicit TaskRun( BatchOptimizationParams params )
+            : params(std::move(params))
+        {
+        }
+
+        // Returns true, if the task is queued or running and has not been
+        // cancelled, or if it has finished successfully.
+        bool isReusable() const
+        {
+            if ( done.wait_for( std::chrono::seconds(0) ) ==
+                 std::future_status::ready )
+                return succeeded;
+            return !cancelled;
+        }
+
+        const BatchOptimizationParams params;
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> succeeded{false};
+        const std::shared_ptr<TaskMetrics> metrics =
+                std::make_shared<TaskMetrics>();
+        // Released when the task has finished, which removes the progress
+        // bar once all tasks of the group have finished.
+        std::shared_ptr<ProgressGroup> progressGroup;
+        size_t progressIndex{};
+        // The number of the batch run which has queued the task.
+        size_t run{};
+        // Written by the task. Must only be read after it has finished.
+        std::stringstream output;
+        std::shared_future<void> done;
+    };
+    using TaskRuns = std::vector<std::shared_ptr<TaskRun> >;
 
     struct SharedData
     {
-        bool cancelled{};
         bool isRunning{};
+        // Set while runScalingBenchmark() runs. It uses its own executors.
+        bool isBenchmarking{};
+        // Incremented whenever a batch run starts while none is running.
+        size_t nRuns{};
+        // The tasks of the current or last batch run in script order.
+        TaskRuns tasks;
+        // Tasks removed by an incremental re-run which may still be
+        // running. They must finish before the executor is destroyed.
+        TaskRuns retiredTasks;
     };
+
+    bool runBatchStep( TaskRun & task );
+    TaskRuns updateTasks(
+            SharedData & shared,
+            const std::vector<BatchOptimizationParams> & optParams,
+            bool incremental );
+    void queueTasks(
+            const TaskRuns & newTasks,
+            size_t run,
+            cu::ParallelExecutor & executor,
+            WorkerPinner & pinner );
+    void runScalingBenchmark(
+            const std::vector<BatchOptimizationParams> & optParams,
+            const WorkerPlacement & placement );
+    void waitForBatch( size_t run,
+                       size_t nWorkers,
+                       std::shared_ptr<const WorkerPinner> pinner );
+
+    Ui::MainWindow ui;
+    MetricsServer * metricsServer{};
+
     cu::Monitor<SharedData> shared;
+    // Replaced only while shared.isRunning is false, when no task is
+    // executing. The tasks use the pinner on the worker threads.
+    std::shared_ptr<WorkerPinner> pinner;
+    std::unique_ptr<cu::ParallelExecutor> executor;
+    WorkerPlacement executorPlacement;
+    // Declared last, so it finishes waiting for the tasks before the
+    // executor is destroyed.
     qu::LoopThread optimizationWorker;
 };
 
@@ -81,6 +168,23 @@ MainWindow::MainWindow(QWidget *parent)
     progressManager.release();
     m->ui.textEditor->setPlainText(
                 QSettings().value( tasksTextName ).toString() );
+    m->ui.incrementalCheckBox->setChecked(
+                QSettings().value( incrementalName, false ).toBool() );
+
+    const auto metricsPort = quint16( QSettings().value(
+                metricsPortName, defaultMetricsPort ).toUInt() );
+    if ( metricsPort != 0 )
+    {
+        m->metricsServer = new MetricsServer{this};
+        if ( m->metricsServer->listen( metricsPort ) )
+            m->ui.statusbar->showMessage(
+                QString("Serving live metrics at http://127.0.0.1:%1/metrics")
+                    .arg( metricsPort ), 5000 );
+        else
+            m->ui.statusbar->showMessage(
+                QString("Could not serve live metrics on port %1.")
+                    .arg( metricsPort ), 5000 );
+    }
 }
 
 MainWindow::~MainWindow()
@@ -91,6 +195,9 @@ MainWindow::~MainWindow()
         QSettings().setValue(
                     tasksTextName,
                     m->ui.textEditor->toPlainText() );
+        QSettings().setValue(
+                    incrementalName,
+                    m->ui.incrementalCheckBox->isChecked() );
     };
 }
 
@@ -98,16 +205,33 @@ void MainWindow::cancelRun()
 {
     m->shared( []( Impl::SharedData & shared )
     {
-        shared.cancelled = true;
+        for ( const auto & task : shared.tasks )
+            task->cancelled = true;
     });
 }
 
 
-void MainWindow::Impl::runBatchStep(
-        BatchOptimizationParams optParam,
-        cu::ProgressInterface * progress,
-        std::ostream & os )
+bool MainWindow::Impl::runBatchStep( TaskRun & task )
 {
+    // The copy is made by the worker thread, so the samples and the swarm
+    // state are allocated on the NUMA node of the worker, if pinned.
+    auto optParam = task.params;
+    auto & progress = task.progressGroup->parProgress->
+            getTaskProgressInterface( task.progressIndex );
+    auto & metrics = *task.metrics;
+    auto & os = task.output;
+    optParam.receiveBestFit = [&os,&metrics](
+            const std::vector<double> & //bestParams
+            , double cost
+            , size_t //nSamples
+            , size_t nIter
+            , const std::vector<double> & //f
+            )
+    {
+        os << nIter << ' ' << cost << std::endl;
+        metrics.setBestCost( cost );
+    };
+
     // contains the indexes of the imfs that shall be optimized
     // in order.
     auto imfIndexes = std::vector<size_t>{};
@@ -120,16 +244,23 @@ void MainWindow::Impl::runBatchStep(
         imfIndexes.push_back( imfOptimization.first );
         imfPartSums.push_back( totalImfOptSteps += imfOptimization.second );
     }
+    metrics.start( totalImfOptSteps );
+    // Stays Failed, if an exception leaves this function.
+    auto finalState = TaskMetrics::Failed;
+    CU_SCOPE_EXIT { metrics.finish( finalState ); };
+    // An abort by the user cancels the task, so a re-run does not keep it.
+    const auto isCancelled = [&task,&progress]()
+    {
+        if ( progress.shallAbort() )
+            task.cancelled = true;
+        return task.cancelled.load();
+    };
     optParam.howToContinue =
-            [this,imfIndexes,imfPartSums,&progress]( size_t nIter )
+            [imfIndexes,imfPartSums,&progress,&metrics,isCancelled](
+                size_t nIter )
     {
-        progress->setProgress( double(nIter)/imfPartSums.back() );
-        const auto isCancelled = shared(
-            []( SharedData & shared )
-        {
-            return shared.cancelled;
-        });
-        if ( isCancelled || progress->shallAbort() )
+        progress.setProgress( double(nIter)/imfPartSums.back() );
+        if ( isCancelled() )
             return ~size_t{0};
         const auto it = std::upper_bound(
                 begin(imfPartSums),
@@ -137,107 +268,423 @@ void MainWindow::Impl::runBatchStep(
                 nIter );
         if ( it == end(imfPartSums) )
             return ~size_t{0};
-        return imfIndexes.at( it - begin(imfPartSums) );
+        const auto imfIndex = imfIndexes.at( it - begin(imfPartSums) );
+        metrics.update( imfIndex, nIter );
+        return imfIndex;
     };
     if ( optParam.howToContinue(0) == ~size_t{0} )
-        return;
+    {
+        finalState = TaskMetrics::Cancelled;
+        return false;
+    }
     const auto imfs = dimf::runOptimization( optParam, os);
+    if ( isCancelled() )
+    {
+        finalState = TaskMetrics::Cancelled;
+        return false;
+    }
     printPreprocessedSamples(optParam, os);
     printImfs( imfs, os );
+    finalState = TaskMetrics::Finished;
+    return true;
 }
 
 
-void MainWindow::runBatch()
+MainWindow::Impl::TaskRuns MainWindow::Impl::updateTasks(
+        SharedData & shared,
+        const std::vector<BatchOptimizationParams> & optParams,
+        bool incremental )
 {
-    // parse script, produce optimization parameters.
-    const auto optParams = parseBatch( std::istringstream(
-        m->ui.textEditor->toPlainText().toStdString()) );
+    // Reuse the unchanged tasks of the previous batch run.
+    const auto & previous = incremental ? shared.tasks : TaskRuns{};
+    auto isKept = std::vector<bool>( previous.size() );
+    auto tasks = TaskRuns{};
+    auto newTasks = TaskRuns{};
+    for ( const auto & optParam : optParams )
+    {
+        auto task = std::shared_ptr<TaskRun>{};
+        for ( size_t i = 0; i < previous.size() && !task; ++i )
+        {
+            if ( isKept[i] ||
+                 !previous[i]->isReusable() ||
+                 !isSameTask( previous[i]->params, optParam ) )
+                continue;
+            isKept[i] = true;
+            task = previous[i];
+        }
+        if ( !task )
+        {
+            task = std::make_shared<TaskRun>( optParam );
+            newTasks.push_back( task );
+        }
+        tasks.push_back( task );
+    }
 
-    // check if an optimization is already running. Throw, if so.
-    m->shared( [this]( Impl::SharedData & shared )
+    // Cancel the tasks which have been changed or removed.
+    for ( size_t i = 0; i < previous.size(); ++i )
     {
-        if ( shared.isRunning )
-            CU_THROW( "Batch processing is already in progress." );
-    });
+        if ( isKept[i] )
+            continue;
+        previous[i]->cancelled = true;
+        if ( previous[i]->done.wait_for( std::chrono::seconds(0) ) !=
+             std::future_status::ready )
+            shared.retiredTasks.push_back( previous[i] );
+    }
 
-    // start optimization in worker thread.
-    qu::invokeInThread( &m->optimizationWorker, [=]()
-    { QU_HANDLE_ALL_EXCEPTIONS_FROM {
-        // set cancelled flag and running flag.
-        m->shared( [this]( Impl::SharedData & shared )
+    queueTasks( newTasks, shared.nRuns, *executor, *pinner );
+
+    std::swap( shared.tasks, tasks );
+    return tasks;
+}
+
+
+void MainWindow::Impl::queueTasks(
+        const TaskRuns & newTasks,
+        size_t run,
+        cu::ParallelExecutor & executor,
+        WorkerPinner & pinner )
+{
+    if ( newTasks.empty() )
+        return;
+    const auto progressGroup = std::make_shared<ProgressGroup>();
+    progressGroup->progress = qu::createProgress( "Batch Run" );
+    progressGroup->parProgress = std::make_unique<cu::ParallelProgress>(
+                *progressGroup->progress,
+                newTasks.size(),
+                executor.getNWorkers() );
+    for ( size_t i = 0; i < newTasks.size(); ++i )
+    {
+        newTasks[i]->progressGroup = progressGroup;
+        newTasks[i]->progressIndex = i;
+        newTasks[i]->run = run;
+        // A raw pointer avoids a reference cycle through the future.
+        // The task is kept alive by shared until it has finished.
+        const auto task = newTasks[i].get();
+        const auto pinnerPtr = &pinner;
+        task->done = executor.addTask( [this,task,pinnerPtr]()
         {
-            shared.cancelled = false;
-            shared.isRunning = true;
+            CU_SCOPE_EXIT { task->progressGroup.reset(); };
+            pinnerPtr->pinCurrentThread();
+            task->succeeded = runBatchStep( *task );
+        }).share();
+    }
+}
+
+
+void MainWindow::Impl::waitForBatch(
+        size_t run,
+        size_t nWorkers,
+        std::shared_ptr<const WorkerPinner> pinner )
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // print the results in script order as soon as they are available.
+    // Incremental re-runs may change the tasks meanwhile, so repeat until
+    // they are stable. Tasks kept by a re-run are printed only once.
+    auto tasks = TaskRuns{};
+    auto printedTasks = std::set<const TaskRun *>{};
+    auto isCancelled = false;
+    auto exception = std::exception_ptr{};
+    for (;;)
+    {
+        auto retiredTasks = TaskRuns{};
+        shared( [&]( SharedData & shared )
+        {
+            tasks = shared.tasks;
+            retiredTasks = shared.retiredTasks;
         });
-        CU_SCOPE_EXIT {
-            m->shared( [this]( Impl::SharedData & shared )
-            { shared.isRunning = false; });
-        };
-
-        // run script in loop.
-        const auto progress = qu::createProgress( "Batch Run" );
-        const auto nOptParams = optParams.size();
-        // parProgress must be declared before executor. This ensures, that
-        // all tasks are completed before the destructor of parProgress is
-        // called. parProgress must not be destroyed before the tasks finish
-        // since the tasks access parProgress. This is the reason parProgress
-        // is made a unique_ptr, so it can be initialized after executor
-        // and destroyed after executor.
-        std::unique_ptr<cu::ParallelProgress> parProgress;
-        std::vector<std::future<void> > tasks;
-        std::vector<std::stringstream> sss(nOptParams);
-        cu::ParallelExecutor executor;
-        parProgress = std::make_unique<cu::ParallelProgress>(
-                    *progress, nOptParams, executor.getNWorkers() );
-        // Queue up the tasks.
-        for ( size_t i = 0; i < nOptParams; ++i )
+        auto isChanged = false;
+        for ( const auto & task : tasks )
         {
-            auto optParam = optParams[i];
-            auto & ss = sss[i];
-            optParam.receiveBestFit = [&ss](
-                    const std::vector<double> & //bestParams
-                    , double cost
-                    , size_t //nSamples
-                    , size_t nIter
-                    , const std::vector<double> & //f
-                    )
+            if ( isCancelled || exception )
+                break;
+            if ( printedTasks.count( task.get() ) )
+                continue;
+            task->done.wait();
+            // A re-run may have removed the task and cancelled it.
+            isChanged = shared( [&]( SharedData & shared )
+            {
+                return shared.tasks != tasks;
+            });
+            if ( isChanged )
+                break;
+            printedTasks.insert( task.get() );
+            try
+            {
+                task->done.get();
+            }
+            catch (...)
             {
-                ss << nIter << ' ' << cost << std::endl;
-            };
-
-            tasks.push_back( executor.addTask( [=,&parProgress, &ss](){
-                m->runBatchStep( optParam,
-                                 &parProgress->getTaskProgressInterface( i ),
-                                 ss );
-            }) );
+                exception = std::current_exception();
+                break;
+            }
+            std::cout << task->output.str() << std::flush;
+            isCancelled = !task->succeeded;
         }
-        // wait for the tasks to finish.
-        for ( size_t i = 0; i != tasks.size(); ++i )
+        if ( isChanged )
+            continue;
+        for ( const auto & task : tasks )
+            task->done.wait();
+        for ( const auto & task : retiredTasks )
+            task->done.wait();
+        const auto isStable = shared( [&]( SharedData & shared )
         {
-            tasks[i].get();
-            const auto isCancelled = m->shared(
-                []( Impl::SharedData & shared )
-            {
-                return shared.cancelled;
-            });
-            std::cout << sss[i].str();
-            if ( isCancelled || progress->shallAbort() )
+            if ( shared.tasks != tasks ||
+                 shared.retiredTasks.size() != retiredTasks.size() )
+                return false;
+            shared.retiredTasks.clear();
+            shared.isRunning = false;
+            return true;
+        });
+        if ( isStable )
+            break;
+    }
+
+    if ( exception )
+        std::rethrow_exception( exception );
+    if ( isCancelled )
+    {
+        qu::invokeInGuiThread( [this]()
+        {
+            ui.statusbar->showMessage(
+                QString("Optimization run was cancelled.")
+                , 5000 );
+        } );
+        return;
+    }
+    // Only report the tasks which have been computed by this batch run,
+    // not the ones kept from a previous one.
+    const auto nComputedTasks = size_t( std::count_if(
+                begin(tasks), end(tasks),
+                [run]( const std::shared_ptr<TaskRun> & task )
+                { return task->run == run; } ) );
+    const auto seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - startTime ).count();
+    if ( nComputedTasks != 0 && seconds > 0 )
+        std::clog << "Processed " << nComputedTasks << " tasks with "
+                  << nWorkers << " workers"
+                  << ( !pinner ? ""
+                       : pinner->hasPinningFailed() ? " (pinning failed)"
+                       : " (pinned)" )
+                  << " in " << seconds << " s ("
+                  << nComputedTasks / seconds << " tasks/s)." << std::endl;
+    qu::invokeInGuiThread( [this]()
+    {
+        ui.statusbar->showMessage(
+            QString("All optimization runs finished successfully.")
+            , 5000 );
+    } );
+}
+
+
+// Determines the number of workers from the placement and the cores
+// returned by getWorkerCpus().
+static size_t getNWorkers( const WorkerPlacement & placement,
+                           const std::vector<int> & cpus )
+{
+    if ( placement.nWorkers != 0 )
+        return placement.nWorkers;
+    if ( cpus.empty() )
+        return std::max( std::thread::hardware_concurrency(), 1u );
+    return cpus.size();
+}
+
+
+void MainWindow::Impl::runScalingBenchmark(
+        const std::vector<BatchOptimizationParams> & optParams,
+        const WorkerPlacement & placement )
+{
+    CU_SCOPE_EXIT {
+        shared( []( SharedData & shared )
+        {
+            shared.isRunning = false;
+            shared.isBenchmarking = false;
+        });
+    };
+
+    const auto cpus = getWorkerCpus( placement.physicalCoresOnly );
+    const auto maxWorkers = getNWorkers( placement, cpus );
+    auto workerCounts = std::vector<size_t>{};
+    for ( auto nWorkers = size_t{1}; nWorkers < maxWorkers; nWorkers *= 2 )
+        workerCounts.push_back( nWorkers );
+    workerCounts.push_back( maxWorkers );
+
+    struct Measurement
+    {
+        size_t nWorkers;
+        double seconds;
+        bool hasPinningFailed;
+    };
+    auto measurements = std::vector<Measurement>{};
+    auto tasks = TaskRuns{};
+    for ( const auto nWorkers : workerCounts )
+    {
+        // Every run computes all tasks with a fresh set of workers.
+        WorkerPinner pinner{ placement.pinWorkers ? cpus : std::vector<int>{} };
+        cu::ParallelExecutor executor( nWorkers );
+        tasks.clear();
+        for ( const auto & optParam : optParams )
+            tasks.push_back( std::make_shared<TaskRun>( optParam ) );
+        auto replacedTasks = TaskRuns{};
+        const auto startTime = std::chrono::steady_clock::now();
+        shared( [&]( SharedData & shared )
+        {
+            ++shared.nRuns;
+            queueTasks( tasks, shared.nRuns, executor, pinner );
+            replacedTasks = shared.tasks;
+            shared.tasks = tasks;
+        });
+        if ( metricsServer )
+        {
+            auto taskMetrics =
+                    std::vector<std::shared_ptr<const TaskMetrics> >{};
+            for ( const auto & task : tasks )
+                taskMetrics.push_back( task->metrics );
+            metricsServer->setMetrics(
+                        std::make_shared<BatchMetrics>( std::move(taskMetrics) ) );
+        }
+        for ( const auto & task : tasks )
+            task->done.wait();
+        const auto seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - startTime ).count();
+        for ( const auto & task : tasks )
+        {
+            task->done.get();
+            if ( !task->succeeded )
             {
                 qu::invokeInGuiThread( [this]()
                 {
-                    m->ui.statusbar->showMessage(
-                        QString("Optimization run was cancelled.")
+                    ui.statusbar->showMessage(
+                        QString("Scaling benchmark was cancelled.")
                         , 5000 );
                 } );
                 return;
             }
         }
-        qu::invokeInGuiThread( [this]()
+        measurements.push_back(
+            Measurement{ nWorkers, seconds,
+                         placement.pinWorkers && pinner.hasPinningFailed() } );
+    }
+
+    // print the results of the run with all workers and the scaling table.
+    for ( const auto & task : tasks )
+        std::cout << task->output.str();
+    std::cout << std::flush;
+    const auto nTasks = optParams.size();
+    std::clog << "Scaling of " << nTasks << " tasks"
+              << ( placement.pinWorkers ? " with pinned workers" : "" )
+              << ":\n"
+              << "workers\tseconds\ttasks/s\tspeedup\tefficiency\n";
+    for ( const auto & measurement : measurements )
+    {
+        const auto speedup = measurements.front().seconds /
+                measurement.seconds;
+        std::clog << measurement.nWorkers << '\t'
+                  << measurement.seconds << '\t'
+                  << nTasks / measurement.seconds << '\t'
+                  << speedup << '\t'
+                  << speedup / measurement.nWorkers
+                  << ( measurement.hasPinningFailed ? "\t(pinning failed)" : "" )
+                  << '\n';
+    }
+    std::clog << std::flush;
+    qu::invokeInGuiThread( [this]()
+    {
+        ui.statusbar->showMessage(
+            QString("Scaling benchmark finished.")
+            , 5000 );
+    } );
+}
+
+
+void MainWindow::runBatch()
+{
+    // parse script, produce optimization parameters.
+    const auto batch = parseBatch( std::istringstream(
+        m->ui.textEditor->toPlainText().toStdString()) );
+    const auto & placement = batch.workerPlacement;
+    const auto incremental = m->ui.incrementalCheckBox->isChecked();
+
+    if ( placement.benchmarkScaling )
+    {
+        m->shared( []( Impl::SharedData & shared )
         {
-            m->ui.statusbar->showMessage(
-                QString("All optimization runs finished successfully.")
-                , 5000 );
-        } );
+            if ( shared.isRunning )
+                CU_THROW( "Batch processing is already in progress." );
+            shared.isRunning = true;
+            shared.isBenchmarking = true;
+        });
+        qu::invokeInThread( &m->optimizationWorker, [=]()
+        { QU_HANDLE_ALL_EXCEPTIONS_FROM {
+            m->runScalingBenchmark( batch.tasks, placement );
+        }; } );
+        return;
+    }
+
+    // The replaced tasks are destroyed after the lock is released.
+    auto replacedTasks = Impl::TaskRuns{};
+    auto metrics = std::shared_ptr<BatchMetrics>{};
+    auto run = size_t{};
+    auto isPlacementIgnored = false;
+    const auto startWorker = m->shared( [&]( Impl::SharedData & shared )
+    {
+        // check if an optimization is already running. Throw, if so.
+        if ( shared.isBenchmarking )
+            CU_THROW( "A scaling benchmark is in progress." );
+        if ( shared.isRunning && !incremental )
+            CU_THROW( "Batch processing is already in progress." );
+
+        // A running batch keeps its workers. The placement does not
+        // change the results, so the tasks are reused nevertheless.
+        isPlacementIgnored = shared.isRunning &&
+                placement != m->executorPlacement;
+        if ( !shared.isRunning )
+        {
+            ++shared.nRuns;
+            // determine the number of workers and the cores they run on.
+            // All tasks have finished, so the old executor is idle.
+            const auto cpus = getWorkerCpus( placement.physicalCoresOnly );
+            const auto nWorkers = getNWorkers( placement, cpus );
+            m->executor.reset();
+            m->pinner = std::make_shared<WorkerPinner>(
+                        placement.pinWorkers ? cpus : std::vector<int>{} );
+            m->executor = std::make_unique<cu::ParallelExecutor>( nWorkers );
+            m->executorPlacement = placement;
+        }
+        run = shared.nRuns;
+        replacedTasks = m->updateTasks( shared, batch.tasks, incremental );
+
+        auto taskMetrics = std::vector<std::shared_ptr<const TaskMetrics> >{};
+        for ( const auto & task : shared.tasks )
+            taskMetrics.push_back( task->metrics );
+        metrics = std::make_shared<BatchMetrics>( std::move(taskMetrics) );
+
+        const auto wasRunning = shared.isRunning;
+        shared.isRunning = true;
+        return !wasRunning;
+    });
+    if ( m->metricsServer )
+        m->metricsServer->setMetrics( metrics );
+    if ( !startWorker )
+    {
+        m->ui.statusbar->showMessage(
+            isPlacementIgnored
+            ? QString("Updated the running batch. The changed worker "
+                      "placement takes effect on the next full run.")
+            : QString("Updated the running batch.")
+            , 5000 );
+        return;
+    }
+
+    // wait for the optimization in worker thread.
+    const auto nWorkers = m->executor->getNWorkers();
+    // Pinning failures are only known after the tasks have run.
+    const auto pinner = placement.pinWorkers
+            ? std::shared_ptr<const WorkerPinner>( m->pinner )
+            : std::shared_ptr<const WorkerPinner>();
+    qu::invokeInThread( &m->optimizationWorker, [=]()
+    { QU_HANDLE_ALL_EXCEPTIONS_FROM {
+        m->waitForBatch( run, nWorkers, pinner );
     }; } );
 }
 
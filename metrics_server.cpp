@@ -0,0 +1,97 @@
+#include "metrics_server.h"
+#include "batch_metrics.h"
+
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace gui {
+
+static QByteArray makeHttpResponse( const QByteArray & status,
+                                    const QByteArray & contentType,
+                                    const QByteArray & body )
+{
+    return "HTTP/1.0 " + status + "\r\n"
+           "Content-Type: " + contentType + "\r\n"
+           "Content-Length: " + QByteArray::number( body.size() ) + "\r\n"
+           "Connection: close\r\n"
+           "\r\n" + body;
+}
+
+MetricsServer::MetricsServer( QObject * parent )
+    : QObject{parent}
+    , server{ new QTcpServer{this} }
+{
+    connect( server, &QTcpServer::newConnection,
+             this, &MetricsServer::acceptConnections );
+}
+
+MetricsServer::~MetricsServer()
+{
+}
+
+bool MetricsServer::listen( quint16 port )
+{
+    return server->listen( QHostAddress::LocalHost, port );
+}
+
+void MetricsServer::setMetrics( std::shared_ptr<const BatchMetrics> metrics_ )
+{
+    metrics( [&]( std::shared_ptr<const BatchMetrics> & current )
+    {
+        current = std::move(metrics_);
+    });
+}
+
+void MetricsServer::acceptConnections()
+{
+    while ( const auto socket = server->nextPendingConnection() )
+    {
+        connect( socket, &QTcpSocket::disconnected,
+                 socket, &QObject::deleteLater );
+        connect( socket, &QTcpSocket::readyRead, socket, [this,socket]()
+        {
+            // Wait until the request line has arrived completely.
+            if ( !socket->canReadLine() )
+                return;
+            const auto requestLine = socket->readLine().trimmed().split(' ');
+            const auto currentMetrics = metrics(
+                []( const std::shared_ptr<const BatchMetrics> & current )
+            {
+                return current;
+            });
+            auto response = QByteArray{};
+            if ( requestLine.size() < 2 || requestLine[0] != "GET" )
+                response = makeHttpResponse(
+                            "405 Method Not Allowed", "text/plain",
+                            "Only GET is supported.\n" );
+            else if ( requestLine[1] != "/metrics" &&
+                      requestLine[1] != "/metrics.json" )
+                response = makeHttpResponse(
+                            "404 Not Found", "text/plain",
+                            "Try /metrics or /metrics.json.\n" );
+            else if ( !currentMetrics )
+                response = makeHttpResponse(
+                            "503 Service Unavailable", "text/plain",
+                            "No batch has been run yet.\n" );
+            else if ( requestLine[1] == "/metrics" )
+                response = makeHttpResponse(
+                            "200 OK", "text/plain; version=0.0.4",
+                            QByteArray::fromStdString(
+                                currentMetrics->toPrometheusText() ) );
+            else
+                response = makeHttpResponse(
+                            "200 OK", "application/json",
+                            QByteArray::fromStdString(
+                                currentMetrics->toJson() ) );
+            // Later segments of the request must not be taken for another
+            // request line.
+            QObject::disconnect( socket, &QTcpSocket::readyRead,
+                                 nullptr, nullptr );
+            socket->write( response );
+            socket->disconnectFromHost();
+        });
+    }
+}
+
+} // namespace gui
@@ -0,0 +1,43 @@
+/** @file
+  @author Ralph Tandetzky
+  @date 19 Oct 2026
+*/
+
+#pragma once
+
+#include "../cpp_utils/locking.h"
+
+#include <QObject>
+#include <memory>
+
+class BatchMetrics;
+class QTcpServer;
+
+namespace gui {
+
+/// Serves the metrics of the current batch run over HTTP on localhost.
+///
+/// @c GET /metrics returns the Prometheus text format and
+/// @c GET /metrics.json returns JSON. The server lives in the GUI thread.
+/// @c setMetrics() may be called from any thread.
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer( QObject * parent = nullptr );
+    ~MetricsServer();
+
+    /// Starts listening. Returns @c false, if the port could not be bound.
+    bool listen( quint16 port );
+
+    void setMetrics( std::shared_ptr<const BatchMetrics> metrics );
+
+private:
+    void acceptConnections();
+
+    QTcpServer * server;
+    cu::Monitor<std::shared_ptr<const BatchMetrics> > metrics;
+};
+
+} // namespace gui
@@ -9,6 +9,8 @@
 #include <cassert>
 #include <functional>
 #include <map>
+#include <set>
+#include <thread>
 
 
 namespace {
@@ -96,6 +98,11 @@ namespace {
                     std::make_pair(varName,
                     [&x](std::istream & is)
                 {
+                    // Streams wrap negative numbers into unsigned types
+                    // without failing.
+                    if ( std::is_unsigned<T>::value &&
+                         (is >> std::ws).peek() == '-' )
+                        CU_THROW( "The variable value must not be negative." );
                     auto value = T{};
                     is >> value;
                     if ( is.fail() || is.bad() )
@@ -114,24 +121,49 @@ namespace {
         ValueReadersType & valueReaders;
     };
 
-    ValueReadersType makeValueReaders( BatchOptimizationParams & params )
+    ValueReadersType makeValueReaders(
+            BatchOptimizationParams & params,
+            WorkerPlacement & placement )
     {
         ValueReadersType valueReaders;
         iterateMembers( params, ValueReaderMaker(valueReaders) );
+        iterateMembers( placement, ValueReaderMaker(valueReaders) );
         const auto nErasedItems = valueReaders.erase( "xIntervalWidth" );
         assert( nErasedItems == 1 );
         return valueReaders;
     }
 
+    class NameCollector
+    {
+    public:
+        NameCollector( std::set<std::string> & names )
+            : names(names)
+        {
+        }
+
+        template <typename T>
+        void operator()( T &, const char * varName ) const
+        {
+            names.insert( varName );
+        }
+
+    private:
+        std::set<std::string> & names;
+    };
+
     class ParamParser
     {
     public:
-        ParamParser( BatchOptimizationParams & params )
-            : valueReaders(makeValueReaders(params))
+        ParamParser( BatchOptimizationParams & params,
+                     WorkerPlacement & placement )
+            : valueReaders(makeValueReaders(params,placement))
+            , placement(placement)
         {
+            iterateMembers( placement, NameCollector(placementNames) );
         }
 
-        void setParam( std::istream & is ) const
+        void setParam( std::istream & is,
+                       std::map<std::string,std::string> & settings ) const
         {
             auto varName = std::string{};
             is >> varName;
@@ -160,11 +192,33 @@ namespace {
                 CU_THROW( message + " Did you mean '" +
                           minDistName + "'?" );
             }
-            valueReaders.at(varName)( is );
+            auto value = std::string{};
+            std::getline( is >> std::ws, value );
+            value.erase( value.find_last_not_of( " \t\r" ) + 1 );
+            std::istringstream valueStream{value};
+            valueReaders.at(varName)( valueStream );
+            // The worker placement applies to the whole batch and does
+            // not change the result of a task.
+            if ( placementNames.count(varName) == 0 )
+                settings[varName] = value;
+            else
+                checkWorkerPlacement();
         }
 
     private:
+        void checkWorkerPlacement() const
+        {
+            const auto maxWorkers = size_t{16} *
+                    std::max( std::thread::hardware_concurrency(), 1u );
+            if ( placement.nWorkers > maxWorkers )
+                CU_THROW( "The number of workers must not exceed " +
+                          std::to_string(maxWorkers) + ", which is 16 "
+                          "times the number of hardware threads." );
+        }
+
         ValueReadersType valueReaders;
+        const WorkerPlacement & placement;
+        std::set<std::string> placementNames;
     };
 
 } // unnamed namespace
@@ -259,7 +313,7 @@ static bool runLine(
     lineStream >> command;
     if ( command == "set" )
     {
-        paramParser.setParam( lineStream );
+        paramParser.setParam( lineStream, params.settings );
         return false;
     }
     if ( command == "new_task" )
@@ -309,19 +363,31 @@ static bool runLine(
 }
 
 
-std::vector<BatchOptimizationParams> parseBatch(
+bool isSameTask( const BatchOptimizationParams & lhs,
+                 const BatchOptimizationParams & rhs )
+{
+    return lhs.settings         == rhs.settings         &&
+           lhs.imfOptimizations == rhs.imfOptimizations &&
+           lhs.preprocessing    == rhs.preprocessing    &&
+           lhs.interprocessing  == rhs.interprocessing  &&
+           lhs.xIntervalWidth   == rhs.xIntervalWidth   &&
+           lhs.samples          == rhs.samples;
+}
+
+
+BatchScript parseBatch(
         std::istream & is )
 {
-    auto result = std::vector<BatchOptimizationParams>{};
+    auto result = BatchScript{};
     auto params = BatchOptimizationParams{};
-    const auto paramParser = ParamParser{params};
+    const auto paramParser = ParamParser{params,result.workerPlacement};
     params.initializer = &dimf::getInitialApproximationByInterpolatingZeros;
     const auto lines = cu::extractByLine( is );
     for ( auto lineNumber = size_t{}; lineNumber < lines.size(); ++lineNumber )
         try
         {
             if ( runLine( params, lines[lineNumber], paramParser ) )
-                result.push_back( params );
+                result.tasks.push_back( params );
         }
         catch (...)
         {
@@ -7,6 +7,8 @@
 
 #include "../decompose_imf_lib/optimization_task.h"
 
+#include <map>
+#include <string>
 #include <vector>
 #include <iosfwd>
 
@@ -24,6 +26,10 @@ set sigmaDevUnits 8
 set tauDevUnits 8
 set freqSwingFactor 1
 set initializer fourier_component
+set nWorkers 0
+set pinWorkers 1
+set physicalCoresOnly 1
+set benchmarkScaling 0
 add_imf_optimization 0 100000
 add_imf_optimization 1 100000
 add_imf_optimization 2 100000
@@ -71,6 +77,9 @@ new_task
 struct BatchOptimizationParams : dimf::OptimizationParams
 {
     std::vector<std::pair<size_t,size_t> > imfOptimizations;
+    /// The values assigned by 'set' commands so far, as written in the
+    /// script. The initializer cannot be compared, but its name can.
+    std::map<std::string,std::string> settings;
 };
 
 template <typename F>
@@ -82,8 +91,59 @@ void iterateMembers( BatchOptimizationParams & params, F && f )
     f( params.imfOptimizations, "imfOptimizations"       );
 }
 
-std::vector<BatchOptimizationParams> parseBatch( std::istream & is );
-inline std::vector<BatchOptimizationParams> parseBatch( std::istream && is )
+/// Controls how the worker threads of a batch run are placed on the cores
+/// of the machine. These values apply to the whole batch, not to single
+/// tasks. The last value set in a script wins.
+struct WorkerPlacement
+{
+    /// The number of worker threads. Zero means one worker per usable core.
+    size_t nWorkers = 0;
+    /// Pin each worker thread to one core. The data of each task is then
+    /// allocated by the worker and therefore on its local NUMA node.
+    bool pinWorkers = false;
+    /// Use only one hardware thread per physical core.
+    bool physicalCoresOnly = false;
+    /// Run the batch with 1, 2, 4, ... workers up to the full number of
+    /// workers and report the throughput of each run.
+    bool benchmarkScaling = false;
+};
+
+inline bool operator==( const WorkerPlacement & lhs,
+                        const WorkerPlacement & rhs )
+{
+    return lhs.nWorkers          == rhs.nWorkers          &&
+           lhs.pinWorkers        == rhs.pinWorkers        &&
+           lhs.physicalCoresOnly == rhs.physicalCoresOnly &&
+           lhs.benchmarkScaling  == rhs.benchmarkScaling;
+}
+
+inline bool operator!=( const WorkerPlacement & lhs,
+                        const WorkerPlacement & rhs )
+{
+    return !(lhs == rhs);
+}
+
+template <typename F>
+void iterateMembers( WorkerPlacement & placement, F && f )
+{
+    f( placement.nWorkers         , "nWorkers"          );
+    f( placement.pinWorkers       , "pinWorkers"        );
+    f( placement.physicalCoresOnly, "physicalCoresOnly" );
+    f( placement.benchmarkScaling , "benchmarkScaling"  );
+}
+
+/// Returns @c true, if both tasks would produce the same computation.
+bool isSameTask( const BatchOptimizationParams & lhs,
+                 const BatchOptimizationParams & rhs );
+
+struct BatchScript
+{
+    std::vector<BatchOptimizationParams> tasks;
+    WorkerPlacement workerPlacement;
+};
+
+BatchScript parseBatch( std::istream & is );
+inline BatchScript parseBatch( std::istream && is )
 {
     return parseBatch( is );
 }
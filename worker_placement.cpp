@@ -0,0 +1,145 @@
+#include "worker_placement.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+#ifdef __linux__
+static bool readIntFromFile( const std::string & fileName, int & value )
+{
+    std::ifstream file{fileName};
+    file >> value;
+    return !file.fail();
+}
+
+static int getNumaNodeOfCpu( int cpu )
+{
+    // The directory of a cpu contains a link named 'node<N>' for the
+    // NUMA node it belongs to.
+    const auto dirName =
+            "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    const auto dir = opendir( dirName.c_str() );
+    if ( !dir )
+        return 0;
+    auto node = 0;
+    while ( const auto entry = readdir( dir ) )
+    {
+        const auto name = std::string{entry->d_name};
+        if ( name.size() > 4 && name.compare( 0, 4, "node" ) == 0 &&
+             std::all_of( begin(name)+4, end(name),
+                          []( char c ){ return std::isdigit(
+                                static_cast<unsigned char>(c) ) != 0; } ) )
+        {
+            node = std::stoi( name.substr(4) );
+            break;
+        }
+    }
+    closedir( dir );
+    return node;
+}
+#endif
+
+
+std::vector<int> getWorkerCpus( bool physicalCoresOnly )
+{
+#ifdef __linux__
+    cpu_set_t allowedCpus;
+    CPU_ZERO( &allowedCpus );
+    if ( sched_getaffinity( 0, sizeof(allowedCpus), &allowedCpus ) != 0 )
+        return {};
+
+    // (node, package, core, cpu)
+    using CpuInfo = std::tuple<int,int,int,int>;
+    auto cpuInfos = std::vector<CpuInfo>{};
+    for ( auto cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+    {
+        if ( !CPU_ISSET( cpu, &allowedCpus ) )
+            continue;
+        const auto topologyDir =
+                "/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                "/topology/";
+        auto package = 0;
+        auto core = cpu;
+        readIntFromFile( topologyDir + "physical_package_id", package );
+        readIntFromFile( topologyDir + "core_id", core );
+        cpuInfos.emplace_back( getNumaNodeOfCpu(cpu), package, core, cpu );
+    }
+    std::sort( begin(cpuInfos), end(cpuInfos) );
+
+    // Every physical core shall be used before a second hardware thread
+    // of any core, and consecutive workers shall alternate between the
+    // NUMA nodes. Hence sort by (rank of the hardware thread within its
+    // core, index within the node for that rank, node, cpu).
+    using Placement = std::tuple<int,int,int,int>;
+    auto placements = std::vector<Placement>{};
+    auto nThreadsPerCore = std::map<std::pair<int,int>,int>{};
+    auto nCpusPerNodeAndRank = std::map<std::pair<int,int>,int>{};
+    for ( const auto & cpuInfo : cpuInfos )
+    {
+        const auto node = std::get<0>(cpuInfo);
+        const auto rank = nThreadsPerCore[ std::make_pair(
+                std::get<1>(cpuInfo), std::get<2>(cpuInfo) ) ]++;
+        if ( physicalCoresOnly && rank != 0 )
+            continue;
+        const auto index =
+                nCpusPerNodeAndRank[ std::make_pair( node, rank ) ]++;
+        placements.emplace_back( rank, index, node, std::get<3>(cpuInfo) );
+    }
+    std::sort( begin(placements), end(placements) );
+
+    auto result = std::vector<int>{};
+    for ( const auto & placement : placements )
+        result.push_back( std::get<3>(placement) );
+    return result;
+#else
+    static_cast<void>(physicalCoresOnly);
+    return {};
+#endif
+}
+
+
+WorkerPinner::WorkerPinner( std::vector<int> cpus )
+    : cpus(std::move(cpus))
+    , nPinnedThreads{0}
+    , pinningFailed{this->cpus.empty()}
+{
+}
+
+
+bool WorkerPinner::hasPinningFailed() const
+{
+    return pinningFailed;
+}
+
+
+void WorkerPinner::pinCurrentThread()
+{
+    // Worker threads are created per batch run, hence remembering the
+    // pinner is enough to pin every thread only once.
+    thread_local const WorkerPinner * pinnedBy = nullptr;
+    if ( pinnedBy == this || cpus.empty() )
+        return;
+    pinnedBy = this;
+    const auto cpu = cpus[nPinnedThreads++ % cpus.size()];
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO( &cpuSet );
+    CPU_SET( cpu, &cpuSet );
+    if ( pthread_setaffinity_np( pthread_self(), sizeof(cpuSet), &cpuSet ) != 0 )
+        pinningFailed = true;
+#else
+    static_cast<void>(cpu);
+    pinningFailed = true;
+#endif
+}
@@ -0,0 +1,42 @@
+/** @file
+  @author Ralph Tandetzky
+  @date 19 Oct 2026
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/// Returns the logical CPUs this process may run on. The first hardware
+/// threads of all physical cores come first, alternating between the NUMA
+/// nodes, followed by the second hardware threads and so on. If
+/// @c physicalCoresOnly is @c true, then only the first hardware thread of
+/// each physical core is returned. On platforms without topology
+/// information an empty vector is returned.
+std::vector<int> getWorkerCpus( bool physicalCoresOnly );
+
+/// Hands out the CPUs returned by @c getWorkerCpus() to worker threads.
+///
+/// Each thread calling @c pinCurrentThread() for the first time is bound
+/// to the next CPU in the list. Workers are spread over the physical
+/// cores first and alternate between the NUMA nodes. Memory that the
+/// thread touches first afterwards is allocated on the NUMA node of that
+/// CPU. This function may be called concurrently from several threads.
+class WorkerPinner
+{
+public:
+    explicit WorkerPinner( std::vector<int> cpus );
+
+    void pinCurrentThread();
+
+    /// Returns @c true, if binding any thread to its CPU failed. This is
+    /// always the case, if the pinner has no CPUs to bind to.
+    bool hasPinningFailed() const;
+
+private:
+    const std::vector<int> cpus;
+    std::atomic<size_t> nPinnedThreads;
+    std::atomic<bool> pinningFailed;
+};